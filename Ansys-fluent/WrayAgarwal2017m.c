@@ -8,6 +8,19 @@ Description:
     equation to fix the significant eddy viscosity drop in the zero strain 
     rate region (e.g. channel center)
 
+    C1, sigmaR, fmu, 1/S and grad(R).grad(S) are evaluated once per cell in
+    WA_adjust and stored in user-defined memory, from which the source,
+    diffusivity and viscosity hooks read them. The number of user-defined
+    memory locations has to cover the UDM entries of the enum below.
+
+    The bounded second destruction term is an explicit source unless
+    WA_IMPLICIT_DEST2 is 1, which linearises it as an implicit sink using
+    the active branch of the min.
+
+    The model functions are evaluated with the per-cell kernels shared with
+    the OpenFOAM models, kernels/WrayAgarwalKernels.h has to be added to the
+    header files of the UDF library.
+
     The default model coefficients are
         kappa       0.41
         Cw          8.54
@@ -28,6 +41,9 @@ Reference:
 #include "mem.h"
 #include "math.h"
 
+#define WA_REAL real
+#include "WrayAgarwalKernels.h"
+
 // Coefficients
 #define Kappa       0.41
 #define Cw          8.54
@@ -37,9 +53,16 @@ Reference:
 #define Sigmakw     0.72
 #define C2ke        (C1ke/Kappa/Kappa+Sigmake)
 #define C2kw        (C1kw/Kappa/Kappa+Sigmakw)
+#define Cw3         (Cw*Cw*Cw)
 #define Cm          8.0
 #define WA_SMALL    1e-15
 
+// Implicit treatment of the bounded second destruction term, 0 for the
+// explicit source (default)
+#ifndef WA_IMPLICIT_DEST2
+#define WA_IMPLICIT_DEST2 0
+#endif
+
 // Fields
 enum
 {
@@ -47,7 +70,12 @@ enum
     SRM,
     d,
     nu,
-    f1
+    f1,
+    C1M,
+    SIGMAR,
+    FMU,
+    INVS,
+    GRADRS
 };
 
 #define mut_            C_MU_T(c,t)
@@ -62,32 +90,31 @@ enum
 #define d_              C_WALL_DIST(c,t)
 #define nu_             C_UDMI(c,t,nu)
 #define f1_             C_UDMI(c,t,f1)
+#define C1_             C_UDMI(c,t,C1M)
+#define sigmaR_         C_UDMI(c,t,SIGMAR)
+#define fmu_            C_UDMI(c,t,FMU)
+#define invS_           C_UDMI(c,t,INVS)
+#define GradRGradS_     C_UDMI(c,t,GRADRS)
 
 // Healper functions
 real chi(cell_t c, Thread *t)
 {
-    return R_/nu_;
+    return wa_chi(R_, nu_);
 }
 
 real fmu(cell_t c, Thread *t)
 {
-    real chi3 = pow(chi(c,t),3.0);
-    return chi3 / (chi3 + pow(Cw,3.0));
+    return wa_fmu(chi(c,t), Cw3);
 }
 
 real calculate_f1(cell_t c, Thread *t)
 {
-    real sqrtRS = sqrt(R_*S_);
-    real arg1 = (1.0+d_*sqrtRS/nu_)
-                /
-                (1.0+SQR(MAX(d_*sqrtRS,1.5*R_)/20.0/nu_));
-
-    return MIN(tanh(pow(arg1, 4.0)), 0.9);
+    return wa_f1_2017(d_, R_, S_, nu_);
 }
 
 real blend(cell_t c, Thread *t, real Switch, real psi1, real psi2)
 {
-    return Switch*(psi1-psi2) + psi2;
+    return wa_blend(Switch, psi1, psi2);
 }
 
 real C1(cell_t c, Thread *t)
@@ -109,6 +136,11 @@ DEFINE_ON_DEMAND(WA_setnames)
     Set_User_Memory_Name(d, "d");
     Set_User_Memory_Name(nu, "nu");
     Set_User_Memory_Name(f1, "f1");
+    Set_User_Memory_Name(C1M, "C1");
+    Set_User_Memory_Name(SIGMAR, "sigmaR");
+    Set_User_Memory_Name(FMU, "fmu");
+    Set_User_Memory_Name(INVS, "invS");
+    Set_User_Memory_Name(GRADRS, "GradRGradS");
 }
 
 // Iteration functions
@@ -134,6 +166,12 @@ DEFINE_ADJUST(WA_adjust, d)
 
             // Calculate and bound the switch function f1
             f1_ = calculate_f1(c,t);
+
+            // Store the coefficients used by the hooks
+            C1_ = C1(c, t);
+            sigmaR_ = sigmaR(c, t);
+            fmu_ = fmu(c, t);
+            invS_ = 1.0/S_;
         }
         end_c_loop(c, t)
     }
@@ -146,26 +184,36 @@ DEFINE_ADJUST(WA_adjust, d)
         Scalar_Reconstruction(d, SV_UDS_I(n), -1, SV_UDSI_RG(n), NULL);
         Scalar_Derivatives(d, SV_UDS_I(n), -1, SV_UDSI_G(n), SV_UDSI_RG(n), NULL);
     }
+
+    // Store the product of the gradients used by the sources
+    thread_loop_c(t, d)
+    {
+        begin_c_loop(c, t)
+        {
+            GradRGradS_ = NV_DOT(GradR_,GradS_);
+        }
+        end_c_loop(c, t)
+    }
 }
 
 // Turbulent viscosity
 DEFINE_TURBULENT_VISCOSITY(WA_mut, c, t)
 {
-    return rho_*fmu(c,t)*R_;
+    return rho_*fmu_*R_;
 }
 
 // Transport terms
 DEFINE_DIFFUSIVITY(WA_diffusivity, c, t, eqn)
 {
-    return rho_*sigmaR(c, t)*R_ + mu_;
+    return rho_*sigmaR_*R_ + mu_;
 }
 
 DEFINE_SOURCE(WA_source_prod, c, t, dS, eqn)
 {
     real source;
 
-    source = rho_ * C1(c, t) * R_ * S_;
-    dS[eqn] = rho_ * C1(c, t) * S_;
+    dS[eqn] = rho_*wa_prod(C1_, S_);
+    source = dS[eqn]*R_;
 
     return source;
 }
@@ -174,13 +222,8 @@ DEFINE_SOURCE(WA_source_dest1, c, t, dS, eqn)
 {
     real source;
 
-    source = rho_*(
-        f1_*C2kw*R_/S_*NV_DOT(GradR_,GradS_)
-        );
-
-    dS[eqn] = rho_*(
-        f1_*C2kw/S_*NV_DOT(GradR_,GradS_)
-        );
+    dS[eqn] = rho_*wa_dest1(f1_, C2kw, GradRGradS_, invS_);
+    source = dS[eqn]*R_;
 
     return source;
 }
@@ -190,13 +233,21 @@ DEFINE_SOURCE(WA_source_dest2, c, t, dS, eqn)
     real source;
     real S2 = MAX(SQR(S_), WA_SMALL);
 
-    source = rho_*(
-        -(1.0-f1_)*MIN(C2ke*SQR(R_)/S2*NV_MAG2(GradS_),
-                     Cm*NV_MAG2(GradR_))
-        );
-
+    source = rho_*wa_dest2_bounded
+    (
+        f1_, C2ke, Cm, R_, NV_MAG2(GradS_), NV_MAG2(GradR_), S2
+    );
+
+#if WA_IMPLICIT_DEST2
+    // Implicit sink of the active branch of the min
+    dS[eqn] = -rho_*(1.0 - f1_)*wa_dest2_bounded_Sp
+    (
+        C2ke, Cm, R_, NV_MAG2(GradS_), NV_MAG2(GradR_), S2
+    );
+#else
     // The second destruction term is treated as explicit
     dS[eqn] = 0.0;
+#endif
 
     return source;
 }
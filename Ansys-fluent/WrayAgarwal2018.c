@@ -12,6 +12,19 @@ Description
     equation to fix the significant eddy viscosity drop in the zero strain 
     rate region (e.g. channel center)
 
+    C1, sigmaR, fmu, 1/S and grad(R).grad(S) are evaluated once per cell in
+    WA_adjust and stored in user-defined memory, from which the source,
+    diffusivity and viscosity hooks read them. The number of user-defined
+    memory locations has to cover the UDM entries of the enum below.
+
+    The bounded second destruction term is an explicit source unless
+    WA_IMPLICIT_DEST2 is 1, which linearises it as an implicit sink using
+    the active branch of the min.
+
+    The model functions are evaluated with the per-cell kernels shared with
+    the OpenFOAM models, kernels/WrayAgarwalKernels.h has to be added to the
+    header files of the UDF library.
+
     The default model coefficients are
         kappa       0.41
         Cw          8.54
@@ -36,6 +49,9 @@ Reference:
 #include "mem.h"
 #include "math.h"
 
+#define WA_REAL real
+#include "WrayAgarwalKernels.h"
+
 // Coefficients
 #define Kappa       0.41
 #define Cw          8.54
@@ -45,10 +61,17 @@ Reference:
 #define Sigmakw     0.72
 #define C2ke        (C1ke/Kappa/Kappa+Sigmake)
 #define C2kw        (C1kw/Kappa/Kappa+Sigmakw)
+#define Cw3         (Cw*Cw*Cw)
 #define Cm          8.0
 #define Cmu         0.09
 #define WA_SMALL    1e-15
 
+// Implicit treatment of the bounded second destruction term, 0 for the
+// explicit source (default)
+#ifndef WA_IMPLICIT_DEST2
+#define WA_IMPLICIT_DEST2 0
+#endif
+
 // Fields
 enum
 {
@@ -57,7 +80,12 @@ enum
     W,
     d,
     nu,
-    f1
+    f1,
+    C1M,
+    SIGMAR,
+    FMU,
+    INVS,
+    GRADRS
 };
 
 #define mut_            C_MU_T(c,t)
@@ -73,81 +101,56 @@ enum
 #define d_              C_WALL_DIST(c,t)
 #define nu_             C_UDMI(c,t,nu)
 #define f1_             C_UDMI(c,t,f1)
+#define C1_             C_UDMI(c,t,C1M)
+#define sigmaR_         C_UDMI(c,t,SIGMAR)
+#define fmu_            C_UDMI(c,t,FMU)
+#define invS_           C_UDMI(c,t,INVS)
+#define GradRGradS_     C_UDMI(c,t,GRADRS)
 
 #define WA_SMALL        1e-15
 
 // Healper functions
 real chi(cell_t c, Thread *t)
 {
-    return R_/nu_;
+    return wa_chi(R_, nu_);
 }
 
 real fmu(cell_t c, Thread *t)
 {
-    real chi3 = pow(chi(c,t),3.0);
-    return chi3 / (chi3 + pow(Cw,3.0));
+    return wa_fmu(chi(c,t), Cw3);
 }
 
 void calculate_SW(cell_t c, Thread *t)
 {
-    int i, j;
-    real GradU[ND_ND][ND_ND];
-    real Symm[ND_ND][ND_ND];
-    real Skew[ND_ND][ND_ND];
-    real S2, W2;
+    real Si, Wi;
+
+    // Row-major velocity gradient tensor
+    real GradU[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-    // Initialize velocity gradient tensor
     #if RP_3D
-    GradU[0][0] = C_DUDX(c,t); GradU[0][1] = C_DUDY(c,t); GradU[0][2] = C_DUDZ(c,t);
-    GradU[1][0] = C_DVDX(c,t); GradU[1][1] = C_DVDY(c,t); GradU[1][2] = C_DVDZ(c,t);
-    GradU[2][0] = C_DWDX(c,t); GradU[2][1] = C_DWDY(c,t); GradU[2][2] = C_DWDZ(c,t);
+    GradU[0] = C_DUDX(c,t); GradU[1] = C_DUDY(c,t); GradU[2] = C_DUDZ(c,t);
+    GradU[3] = C_DVDX(c,t); GradU[4] = C_DVDY(c,t); GradU[5] = C_DVDZ(c,t);
+    GradU[6] = C_DWDX(c,t); GradU[7] = C_DWDY(c,t); GradU[8] = C_DWDZ(c,t);
     #else
-    GradU[0][0] = C_DUDX(c,t); GradU[0][1] = C_DUDY(c,t);
-    GradU[1][0] = C_DVDX(c,t); GradU[1][1] = C_DVDY(c,t);                  
+    GradU[0] = C_DUDX(c,t); GradU[1] = C_DUDY(c,t);
+    GradU[3] = C_DVDX(c,t); GradU[4] = C_DVDY(c,t);
     #endif
 
-    // Calculate symmetrical tensor and antisymmetrical tensor 
-    for (i=0; i<ND_ND; ++i)
-    {
-        for(j=0; j<ND_ND; ++j)
-        {
-            Symm[i][j] = 1.0/2.0*(GradU[i][j]+GradU[j][i]);
-            Skew[i][j] = 1.0/2.0*(GradU[i][j]-GradU[j][i]);
-        }
-    }
-
     // Calculate strain rate magnitude and vorticity magnitude
-    S2 = 0;
-    W2 = 0;
-    for (i=0; i<ND_ND; ++i)
-    {
-        for(j=0; j<ND_ND; ++j)
-        {
-            S2 += Symm[i][j]*Symm[i][j];
-            W2 += Skew[i][j]*Skew[i][j];
-        }
-    }
-    S_ = sqrt(2.0*S2);
-    W_ = sqrt(2.0*W2);
+    wa_SW(GradU, &Si, &Wi);
+    S_ = Si;
+    W_ = Wi;
 };
 
 real calculate_f1(cell_t c, Thread *t)
 {
     // Wall Distance Free
-    real WDF_R = W_/S_;
-    real WDF_omega = S_/sqrt(Cmu);
-    real WDF_k = mut_/rho_*WDF_omega;
-    
-    real eta = S_*MAX(1.0, WDF_R);
-    
-    real arg1 = (nu_+R_)/2.0 * SQR(eta) / MAX(Cmu*WDF_k*WDF_omega, WA_SMALL);
-    
-    return tanh(pow(arg1, 4.0));
+    return wa_f1_2018(S_, W_, mut_/rho_, nu_, R_, Cmu);
 }
 
 real blend(cell_t c, Thread *t, real Switch, real psi1, real psi2)
 {
-    return Switch*(psi1-psi2) + psi2;
+    return wa_blend(Switch, psi1, psi2);
 }
 
 real C1(cell_t c, Thread *t)
@@ -170,6 +173,11 @@ DEFINE_ON_DEMAND(WA_setnames)
     Set_User_Memory_Name(d, "d");
     Set_User_Memory_Name(nu, "nu");
     Set_User_Memory_Name(f1, "f1");
+    Set_User_Memory_Name(C1M, "C1");
+    Set_User_Memory_Name(SIGMAR, "sigmaR");
+    Set_User_Memory_Name(FMU, "fmu");
+    Set_User_Memory_Name(INVS, "invS");
+    Set_User_Memory_Name(GRADRS, "GradRGradS");
 }
 
 // Iteration functions
@@ -195,6 +203,12 @@ DEFINE_ADJUST(WA_adjust, d)
 
             // Calculate and bound the switch function f1
             f1_ = calculate_f1(c,t);
+
+            // Store the coefficients used by the hooks
+            C1_ = C1(c, t);
+            sigmaR_ = sigmaR(c, t);
+            fmu_ = fmu(c, t);
+            invS_ = 1.0/S_;
         }
         end_c_loop(c, t)
     }
@@ -207,27 +221,36 @@ DEFINE_ADJUST(WA_adjust, d)
         Scalar_Reconstruction(d, SV_UDS_I(n), -1, SV_UDSI_RG(n), NULL);
         Scalar_Derivatives(d, SV_UDS_I(n), -1, SV_UDSI_G(n), SV_UDSI_RG(n), NULL);
     }
+
+    // Store the product of the gradients used by the sources
+    thread_loop_c(t, d)
+    {
+        begin_c_loop(c, t)
+        {
+            GradRGradS_ = NV_DOT(GradR_,GradS_);
+        }
+        end_c_loop(c, t)
+    }
 }
 
 // Turbulent viscosity
 DEFINE_TURBULENT_VISCOSITY(WA_mut, c, t)
 {
-    return rho_*fmu(c,t)*R_;
+    return rho_*fmu_*R_;
 }
 
 // Transport terms
 DEFINE_DIFFUSIVITY(WA_diffusivity, c, t, eqn)
 {
-    return rho_*sigmaR(c, t)*R_ + mu_;
+    return rho_*sigmaR_*R_ + mu_;
 }
 
 DEFINE_SOURCE(WA_source_prod, c, t, dS, eqn)
 {
     real source;
 
-    source = rho_ * C1(c, t) * R_ * S_;
-    
-    dS[eqn] = rho_ * C1(c, t) * S_;
+    dS[eqn] = rho_*wa_prod(C1_, S_);
+    source = dS[eqn]*R_;
 
     return source;
 }
@@ -236,13 +259,8 @@ DEFINE_SOURCE(WA_source_dest1, c, t, dS, eqn)
 {
     real source;
 
-    source = rho_*(
-        f1_*C2kw*R_/S_*NV_DOT(GradR_,GradS_)
-        );
-
-    dS[eqn] = rho_*(
-        f1_*C2kw/S_*NV_DOT(GradR_,GradS_)
-        );
+    dS[eqn] = rho_*wa_dest1(f1_, C2kw, GradRGradS_, invS_);
+    source = dS[eqn]*R_;
 
     return source;
 }
@@ -252,13 +270,21 @@ DEFINE_SOURCE(WA_source_dest2, c, t, dS, eqn)
     real source;
     real S2 = MAX(SQR(S_), WA_SMALL);
 
-    source = rho_*(
-        -(1.0-f1_)*MIN(C2ke*SQR(R_)/S2*NV_MAG2(GradS_),
-                     Cm*NV_MAG2(GradR_))
-        );
-
+    source = rho_*wa_dest2_bounded
+    (
+        f1_, C2ke, Cm, R_, NV_MAG2(GradS_), NV_MAG2(GradR_), S2
+    );
+
+#if WA_IMPLICIT_DEST2
+    // Implicit sink of the active branch of the min
+    dS[eqn] = -rho_*(1.0 - f1_)*wa_dest2_bounded_Sp
+    (
+        C2ke, Cm, R_, NV_MAG2(GradS_), NV_MAG2(GradR_), S2
+    );
+#else
     // The second destruction term is treated as explicit
     dS[eqn] = 0.0;
+#endif
 
     return source;
 }
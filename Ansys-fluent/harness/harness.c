@@ -0,0 +1,435 @@
+/* Test and benchmark harness of the Wray-Agarwal UDFs
+
+Description
+    Builds one of the UDFs of the parent directory against the stand-in
+    udf.h as an ordinary executable. The UDF is included in this file, which
+    is compiled with
+        -DWA_UDF='"../<UDF>.c"' -DWA_MODEL_<version>
+    where <version> is 2017, 2017m, 2018 or 2017DES, see the Makefile.
+
+    The fields of a channel-like flow are set on a box of nx*ny*nz cells
+    with walls at y = 0 and y = 2. After one WA_adjust pass the stored
+    per-cell values and the viscosity, diffusivity and source hooks are
+    compared against a direct evaluation of the model equations, then the
+    adjust pass and the hooks are timed and reported in cells/s.
+
+Usage
+    <UDF> [nx ny nz [nRepeat]]
+
+    The exit status is non-zero if any value differs from the reference by
+    more than the relative tolerance WA_TOLERANCE.
+
+==========================================================================*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <string.h>
+
+#include WA_UDF
+
+#define WA_TOLERANCE    1e-10
+
+// Channel dimensions
+#define WA_PI   3.14159265358979323846
+#define WA_LX   (2.0*WA_PI)
+#define WA_LY   2.0
+#define WA_LZ   WA_PI
+
+#define WA_RHO  1.2
+#define WA_MU   1.8e-5
+
+#if defined(WA_MODEL_2017)
+#   define WA_MODEL_NAME "WrayAgarwal2017"
+#elif defined(WA_MODEL_2017m)
+#   define WA_MODEL_NAME "WrayAgarwal2017m"
+#elif defined(WA_MODEL_2018)
+#   define WA_MODEL_NAME "WrayAgarwal2018"
+#elif defined(WA_MODEL_2017DES)
+#   define WA_MODEL_NAME "WrayAgarwal2017DES"
+#else
+#   error "Define one of WA_MODEL_2017, 2017m, 2018 or 2017DES"
+#endif
+
+
+// Reference values of a cell
+typedef struct
+{
+    real S;
+    real W;
+    real f1;
+    real fdes;
+    real mut;
+    real diffusivity;
+    real prod, dProd;
+    real dest1, dDest1;
+    real dest2, dDest2;
+} reference;
+
+
+// Wall time [s]
+static double wa_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+
+static void *wa_alloc(size_t n, size_t size)
+{
+    void *ptr = calloc(n, size);
+
+    if (!ptr)
+    {
+        fprintf(stderr, "Cannot allocate %zu bytes\n", n*size);
+        exit(2);
+    }
+
+    return ptr;
+}
+
+
+// Allocate the box and set the fields
+static void wa_setup(Thread *t, int nx, int ny, int nz)
+{
+    const int nCells = nx*ny*nz;
+    cell_t c;
+    int i, n;
+
+    memset(t, 0, sizeof(*t));
+    t->nx = nx;
+    t->ny = ny;
+    t->nz = nz;
+    t->h[0] = WA_LX/nx;
+    t->h[1] = WA_LY/ny;
+    t->h[2] = WA_LZ/nz;
+    t->nCells = nCells;
+
+    for (i=0; i<WA_MAX_UDS; ++i)
+    {
+        t->uds[i] = wa_alloc(nCells, sizeof(real));
+        t->udsG[i] = wa_alloc(nCells, sizeof(*t->udsG[i]));
+    }
+    for (i=0; i<WA_MAX_UDM; ++i)
+    {
+        t->udm[i] = wa_alloc(nCells, sizeof(real));
+    }
+    t->rho = wa_alloc(nCells, sizeof(real));
+    t->mu = wa_alloc(nCells, sizeof(real));
+    t->mut = wa_alloc(nCells, sizeof(real));
+    t->wallDist = wa_alloc(nCells, sizeof(real));
+    t->gradU = wa_alloc(nCells, sizeof(*t->gradU));
+    t->centroid = wa_alloc(nCells, sizeof(*t->centroid));
+    t->faceCentroid = wa_alloc((size_t)nCells*WA_NFACES, sizeof(*t->faceCentroid));
+
+    begin_c_loop(c, t)
+    {
+        const real x = ((c % nx) + 0.5)*t->h[0];
+        const real y = (((c/nx) % ny) + 0.5)*t->h[1];
+        const real z = ((c/(nx*ny)) + 0.5)*t->h[2];
+
+        // Parabolic profile with a three-dimensional perturbation
+        const real eta = y*(2.0 - y);
+        const real detady = 2.0 - 2.0*y;
+        const real pert = 1.0 + 0.1*sin(2*x)*cos(2*z);
+
+        real (*gradU)[ND_ND] = t->gradU[c];
+
+        gradU[0][0] = 1.5*eta*0.2*cos(2*x)*cos(2*z);
+        gradU[0][1] = 1.5*detady*pert;
+        gradU[0][2] = -1.5*eta*0.2*sin(2*x)*sin(2*z);
+        gradU[1][0] = 0.05*cos(x)*eta;
+        gradU[1][1] = 0.05*sin(x)*detady;
+        gradU[1][2] = 0.0;
+        gradU[2][0] = -0.05*sin(x)*eta;
+        gradU[2][1] = 0.05*cos(x)*detady;
+        gradU[2][2] = 0.0;
+
+        t->centroid[c][0] = x;
+        t->centroid[c][1] = y;
+        t->centroid[c][2] = z;
+
+        for (n=0; n<WA_NFACES; ++n)
+        {
+            real *xf = t->faceCentroid[c*WA_NFACES + n];
+            wa_copy(xf, t->centroid[c]);
+            xf[n/2] += (n % 2 ? 0.5 : -0.5)*t->h[n/2];
+        }
+
+        t->rho[c] = WA_RHO;
+        t->mu[c] = WA_MU;
+        t->wallDist[c] = MIN(y, WA_LY - y);
+
+        t->uds[R][c] = 1e-3*(0.05 + eta)*(1.0 + 0.2*sin(z));
+        t->mut[c] = 0.8*WA_RHO*t->uds[R][c];
+    }
+    end_c_loop(c, t)
+}
+
+
+// Direct evaluation of the model equations after WA_adjust
+static void wa_reference(cell_t c, Thread *t, reference *ref)
+{
+    const real rho = t->rho[c];
+    const real mu = t->mu[c];
+    const real nuC = mu/rho;
+    const real Rc = MAX(t->uds[R][c], 0.0);
+    const real *gR = t->udsG[R][c];
+    const real *gS = t->udsG[SRM][c];
+
+    real S2sum = 0, W2sum = 0;
+    real C1c, sigmaRc, chi3, fdes2, S2;
+    int i, j;
+
+    for (i=0; i<ND_ND; ++i)
+    {
+        for (j=0; j<ND_ND; ++j)
+        {
+            S2sum += SQR(0.5*(t->gradU[c][i][j] + t->gradU[c][j][i]));
+            W2sum += SQR(0.5*(t->gradU[c][i][j] - t->gradU[c][j][i]));
+        }
+    }
+
+    ref->S = MAX(sqrt(2.0*S2sum), WA_SMALL);
+    ref->W = sqrt(2.0*W2sum);
+
+#if defined(WA_MODEL_2018)
+    {
+        const real omega = ref->S/sqrt(Cmu);
+        const real k = t->mut[c]/rho*omega;
+        const real eta = ref->S*MAX(1.0, ref->W/ref->S);
+        const real arg = (nuC + Rc)/2.0*SQR(eta)/MAX(Cmu*k*omega, WA_SMALL);
+
+        ref->f1 = tanh(pow(arg, 4.0));
+    }
+#else
+    {
+        const real y = t->wallDist[c];
+        const real arg =
+            (1.0 + y*sqrt(Rc*ref->S)/nuC)
+           /(1.0 + SQR(MAX(y*sqrt(Rc*ref->S), 1.5*Rc)/(20.0*nuC)));
+
+        ref->f1 = MIN(tanh(pow(arg, 4.0)), 0.9);
+    }
+#endif
+
+#if defined(WA_MODEL_2017DES)
+    {
+        // Maximum cell size of the box cells
+        const real deltaC = MAX(MAX(t->h[0], t->h[1]), t->h[2]);
+
+        ref->fdes = MAX(1.0, sqrt(Rc/ref->S)/MAX(CDES*deltaC, WA_SMALL));
+    }
+#else
+    ref->fdes = 1.0;
+#endif
+    fdes2 = SQR(ref->fdes);
+
+    C1c = C1ke + ref->f1*(C1kw - C1ke);
+    sigmaRc = Sigmake + ref->f1*(Sigmakw - Sigmake);
+    chi3 = pow(Rc/nuC, 3.0);
+
+    ref->mut = rho*chi3/(chi3 + pow(Cw, 3.0))*Rc;
+    ref->diffusivity = rho*sigmaRc*Rc + mu;
+
+    ref->prod = rho*C1c*Rc*ref->S;
+    ref->dProd = rho*C1c*ref->S;
+
+    ref->dest1 = rho*ref->f1*C2kw*Rc/ref->S*NV_DOT(gR, gS)/fdes2;
+    ref->dDest1 = rho*ref->f1*C2kw/ref->S*NV_DOT(gR, gS)/fdes2;
+
+    S2 = MAX(SQR(ref->S), WA_SMALL);
+
+#if defined(WA_MODEL_2017m) || defined(WA_MODEL_2018)
+    ref->dest2 =
+       -rho*(1.0 - ref->f1)
+       *MIN(C2ke*SQR(Rc)/S2*NV_MAG2(gS), Cm*NV_MAG2(gR));
+#   if WA_IMPLICIT_DEST2
+    ref->dDest2 =
+       -rho*(1.0 - ref->f1)
+       *MIN(C2ke*Rc/S2*NV_MAG2(gS), Cm*NV_MAG2(gR)/MAX(Rc, WA_SMALL));
+#   else
+    ref->dDest2 = 0.0;
+#   endif
+#else
+    ref->dest2 = -rho*(1.0 - ref->f1)*C2ke*SQR(Rc)/S2*NV_MAG2(gS)/fdes2;
+    ref->dDest2 = -rho*(1.0 - ref->f1)*C2ke*Rc/S2*NV_MAG2(gS)/fdes2;
+#endif
+}
+
+
+// Compare a value against its reference, return 1 if it fails
+static int wa_compare
+(
+    const char *name,
+    cell_t c,
+    real value,
+    real ref,
+    real *maxError
+)
+{
+    const real scale = MAX(fabs(value), fabs(ref));
+    const real error = fabs(value - ref);
+
+    if (scale > 0 && error/scale > *maxError)
+    {
+        *maxError = error/scale;
+    }
+
+    if (error > WA_TOLERANCE*scale + 1e-300)
+    {
+        fprintf
+        (
+            stderr, "cell %d: %s = %.16g, reference %.16g\n",
+            c, name, value, ref
+        );
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// Check the stored values and the hooks of all cells, return the number of
+// failed values
+static int wa_check(Thread *t, real *maxError)
+{
+    const int maxReported = 10;
+    int nFailed = 0;
+    cell_t c;
+
+    begin_c_loop(c, t)
+    {
+        reference ref;
+        real dS[1];
+        real value;
+        int failed = 0;
+
+        wa_reference(c, t, &ref);
+
+        failed += wa_compare("S", c, S_, ref.S, maxError);
+        failed += wa_compare("f1", c, f1_, ref.f1, maxError);
+#if defined(WA_MODEL_2018)
+        failed += wa_compare("W", c, W_, ref.W, maxError);
+#endif
+#if defined(WA_MODEL_2017DES)
+        failed += wa_compare("fdes", c, FDES_, ref.fdes, maxError);
+#endif
+
+        failed += wa_compare("mut", c, WA_mut(c, t), ref.mut, maxError);
+        failed += wa_compare
+        (
+            "diffusivity", c, WA_diffusivity(c, t, 0), ref.diffusivity,
+            maxError
+        );
+
+        value = WA_source_prod(c, t, dS, 0);
+        failed += wa_compare("prod", c, value, ref.prod, maxError);
+        failed += wa_compare("dS prod", c, dS[0], ref.dProd, maxError);
+
+        value = WA_source_dest1(c, t, dS, 0);
+        failed += wa_compare("dest1", c, value, ref.dest1, maxError);
+        failed += wa_compare("dS dest1", c, dS[0], ref.dDest1, maxError);
+
+        value = WA_source_dest2(c, t, dS, 0);
+        failed += wa_compare("dest2", c, value, ref.dest2, maxError);
+        failed += wa_compare("dS dest2", c, dS[0], ref.dDest2, maxError);
+
+        if (failed && ++nFailed >= maxReported)
+        {
+            fprintf(stderr, "...\n");
+            break;
+        }
+    }
+    end_c_loop(c, t)
+
+    return nFailed;
+}
+
+
+// Call the viscosity, diffusivity and source hooks of all cells
+static real wa_hooks(Thread *t)
+{
+    real sum = 0;
+    real dS[1];
+    cell_t c;
+
+    begin_c_loop(c, t)
+    {
+        sum += WA_mut(c, t);
+        sum += WA_diffusivity(c, t, 0);
+        sum += WA_source_prod(c, t, dS, 0) + dS[0];
+        sum += WA_source_dest1(c, t, dS, 0) + dS[0];
+        sum += WA_source_dest2(c, t, dS, 0) + dS[0];
+    }
+    end_c_loop(c, t)
+
+    return sum;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int nx = 64, ny = 64, nz = 32, nRepeat = 10;
+    Thread thread;
+    Domain domain;
+    real maxError = 0, checksum = 0;
+    double t0, adjustTime, hooksTime;
+    int i, nFailed;
+
+    if (argc != 1 && argc != 4 && argc != 5)
+    {
+        fprintf(stderr, "Usage: %s [nx ny nz [nRepeat]]\n", argv[0]);
+        return 2;
+    }
+    if (argc >= 4)
+    {
+        nx = atoi(argv[1]);
+        ny = atoi(argv[2]);
+        nz = atoi(argv[3]);
+    }
+    if (argc == 5)
+    {
+        nRepeat = atoi(argv[4]);
+    }
+    if (nx < 1 || ny < 1 || nz < 1 || nRepeat < 1)
+    {
+        fprintf(stderr, "Invalid box or repeat count\n");
+        return 2;
+    }
+
+    wa_setup(&thread, nx, ny, nz);
+    domain.threads = &thread;
+
+    WA_setnames();
+
+    // Check
+    WA_adjust(&domain);
+    nFailed = wa_check(&thread, &maxError);
+
+    // Time the adjust pass and the hooks
+    t0 = wa_time();
+    for (i=0; i<nRepeat; ++i)
+    {
+        WA_adjust(&domain);
+    }
+    adjustTime = (wa_time() - t0)/nRepeat;
+
+    t0 = wa_time();
+    for (i=0; i<nRepeat; ++i)
+    {
+        checksum += wa_hooks(&thread);
+    }
+    hooksTime = (wa_time() - t0)/nRepeat;
+
+    printf
+    (
+        "%-20s cells %d  max relative error %.3g  %s\n"
+        "%-20s adjust %.4g cells/s  hooks %.4g cells/s  (checksum %.6g)\n",
+        WA_MODEL_NAME, thread.nCells, maxError, nFailed ? "FAILED" : "passed",
+        "", thread.nCells/adjustTime, thread.nCells/hooksTime, checksum
+    );
+
+    return nFailed ? 1 : 0;
+}
@@ -0,0 +1 @@
+/* Stand-in for the Fluent mem.h, the cell macros are in udf.h */
@@ -0,0 +1,188 @@
+/* Stand-in for the Fluent udf.h used by the UDF harness
+
+Description
+    Provides the types, cell macros, loops and DEFINE_* hooks used by the
+    Wray-Agarwal UDFs over a synthetic structured box of hexahedral cells,
+    so that the UDFs can be compiled, checked and timed without Fluent.
+
+    All cells are held in a single cell thread which is also its own face
+    thread. Every cell has six faces whose centroids are the cell centroid
+    shifted by half a cell size in each direction. Scalar_Derivatives
+    evaluates central differences over the box, one-sided at its sides, and
+    C_STRAIN_RATE_MAG is evaluated from the stored velocity gradient.
+
+    Only the subset of the Fluent API used by the UDFs is provided.
+
+==========================================================================*/
+
+#ifndef WA_HARNESS_UDF_H
+#define WA_HARNESS_UDF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+// Dimensions
+#define RP_3D       1
+#define ND_ND       3
+
+// Storage sizes
+#define WA_MAX_UDS  4
+#define WA_MAX_UDM  16
+#define WA_NFACES   6
+
+typedef double real;
+typedef int cell_t;
+typedef int face_t;
+
+typedef struct thread_struct
+{
+    // Box dimensions and cell size
+    int nx, ny, nz;
+    real h[ND_ND];
+
+    int nCells;
+
+    // Cell data
+    real *uds[WA_MAX_UDS];
+    real (*udsG[WA_MAX_UDS])[ND_ND];
+    real *udm[WA_MAX_UDM];
+    real *rho;
+    real *mu;
+    real *mut;
+    real *wallDist;
+    real (*gradU)[ND_ND][ND_ND];
+    real (*centroid)[ND_ND];
+
+    // Face data, faces c*WA_NFACES to c*WA_NFACES + 5 belong to cell c
+    real (*faceCentroid)[ND_ND];
+
+    struct thread_struct *next;
+} Thread;
+
+typedef struct
+{
+    Thread *threads;
+} Domain;
+
+
+// Vector operations
+#define SQR(x)          ((x)*(x))
+#define MAX(a,b)        ((a) > (b) ? (a) : (b))
+#define MIN(a,b)        ((a) < (b) ? (a) : (b))
+#define NV_DOT(a,b)     ((a)[0]*(b)[0] + (a)[1]*(b)[1] + (a)[2]*(b)[2])
+#define NV_MAG2(a)      NV_DOT(a,a)
+
+// Loops
+#define thread_loop_c(t,d)  for ((t) = (d)->threads; (t) != NULL; (t) = (t)->next)
+#define begin_c_loop(c,t)   for ((c) = 0; (c) < (t)->nCells; ++(c))
+#define end_c_loop(c,t)
+#define c_face_loop(c,t,n)  for ((n) = 0; (n) < WA_NFACES; ++(n))
+
+// Cell and face access
+#define C_UDSI(c,t,i)       ((t)->uds[i][c])
+#define C_UDSI_G(c,t,i)     ((t)->udsG[i][c])
+#define C_UDMI(c,t,i)       ((t)->udm[i][c])
+#define C_R(c,t)            ((t)->rho[c])
+#define C_MU_L(c,t)         ((t)->mu[c])
+#define C_MU_T(c,t)         ((t)->mut[c])
+#define C_WALL_DIST(c,t)    ((t)->wallDist[c])
+
+#define C_DUDX(c,t)         ((t)->gradU[c][0][0])
+#define C_DUDY(c,t)         ((t)->gradU[c][0][1])
+#define C_DUDZ(c,t)         ((t)->gradU[c][0][2])
+#define C_DVDX(c,t)         ((t)->gradU[c][1][0])
+#define C_DVDY(c,t)         ((t)->gradU[c][1][1])
+#define C_DVDZ(c,t)         ((t)->gradU[c][1][2])
+#define C_DWDX(c,t)         ((t)->gradU[c][2][0])
+#define C_DWDY(c,t)         ((t)->gradU[c][2][1])
+#define C_DWDZ(c,t)         ((t)->gradU[c][2][2])
+
+#define C_STRAIN_RATE_MAG(c,t)  wa_strain_rate_mag(c,t)
+
+#define C_CENTROID(x,c,t)   wa_copy((x), (t)->centroid[c])
+#define C_FACE(c,t,n)       ((c)*WA_NFACES + (n))
+#define C_FACE_THREAD(c,t,n)    (t)
+#define F_CENTROID(x,f,t)   wa_copy((x), (t)->faceCentroid[f])
+
+// Messages and names
+#define Message             printf
+#define Set_User_Scalar_Name(i,name)
+#define Set_User_Memory_Name(i,name)
+
+// Storage and derivatives
+#define SV_NULL             (-1)
+#define SV_UDS_I(n)         (n)
+#define SV_UDSI_G(n)        (n)
+#define SV_UDSI_RG(n)       (n)
+#define MD_Alloc_Storage_Vars(d, ...)
+#define Scalar_Reconstruction(d, sv, zone, svRG, f)
+#define Scalar_Derivatives(d, sv, zone, svG, svRG, f)   wa_derivatives(d, sv)
+
+// Hooks
+#define DEFINE_ON_DEMAND(name)                  void name(void)
+#define DEFINE_ADJUST(name, d)                  void name(Domain *d)
+#define DEFINE_TURBULENT_VISCOSITY(name, c, t)  real name(cell_t c, Thread *t)
+#define DEFINE_DIFFUSIVITY(name, c, t, i)       real name(cell_t c, Thread *t, int i)
+#define DEFINE_SOURCE(name, c, t, dS, eqn) \
+    real name(cell_t c, Thread *t, real dS[], int eqn)
+
+
+// Helper functions
+
+static inline void wa_copy(real *x, const real *y)
+{
+    x[0] = y[0];
+    x[1] = y[1];
+    x[2] = y[2];
+}
+
+static inline real wa_strain_rate_mag(cell_t c, Thread *t)
+{
+    int i, j;
+    real S2 = 0;
+
+    for (i=0; i<ND_ND; ++i)
+    {
+        for (j=0; j<ND_ND; ++j)
+        {
+            S2 += SQR(0.5*(t->gradU[c][i][j] + t->gradU[c][j][i]));
+        }
+    }
+
+    return sqrt(2.0*S2);
+}
+
+static void wa_derivatives(Domain *d, int n)
+{
+    Thread *t;
+
+    thread_loop_c(t, d)
+    {
+        const int stride[ND_ND] = {1, t->nx, t->nx*t->ny};
+        const int size[ND_ND] = {t->nx, t->ny, t->nz};
+        const real *phi = t->uds[n];
+        cell_t c;
+        int dir;
+
+        begin_c_loop(c, t)
+        {
+            const int ijk[ND_ND] =
+                {c % t->nx, (c/t->nx) % t->ny, c/(t->nx*t->ny)};
+
+            for (dir=0; dir<ND_ND; ++dir)
+            {
+                const int lo = ijk[dir] > 0 ? c - stride[dir] : c;
+                const int hi = ijk[dir] < size[dir] - 1 ? c + stride[dir] : c;
+                const int span = (hi - lo)/stride[dir];
+
+                t->udsG[n][c][dir] =
+                    span > 0 ? (phi[hi] - phi[lo])/(span*t->h[dir]) : 0.0;
+            }
+        }
+        end_c_loop(c, t)
+    }
+}
+
+#endif
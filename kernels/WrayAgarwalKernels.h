@@ -0,0 +1,517 @@
+/* Per-cell kernels of the Wray-Agarwal turbulence models
+
+Description
+    Header-only, allocation-free evaluation of the Wray-Agarwal model
+    functions for a single cell or face, shared by the OpenFOAM models
+    (OpenFOAM-5.x/Models) and the Fluent UDFs (Ansys-fluent) so that both
+    evaluate the same expressions:
+
+        wa_chi, wa_fmu, wa_nut          eddy viscosity
+        wa_blend, wa_C1, wa_sigmaR      f1 blending of the coefficients
+        wa_S2, wa_S, wa_W, wa_SW, wa_S2_n
+                                        strain rate and vorticity magnitudes
+        wa_f1_2017, wa_f1_2018          switch functions
+        wa_lrans, wa_fdes_DES           DES length scale ratio
+        wa_rd, wa_fd, wa_fdes_DDES      DDES shielding
+        wa_IDDES_geometry, wa_fdes_IDDES
+                                        IDDES length scale ratio
+        wa_prod, wa_dest1, wa_dest2, wa_dest2_bounded, wa_dest2_bounded_Sp
+                                        linearised source terms
+
+    The functions are valid C99 and C++ and use no branches other than
+    selections, so that loops over contiguous arrays calling them can be
+    vectorised by the compiler. The *_n functions are such loops for the
+    cell-wise evaluations that need no neighbour data.
+
+    If compiled with OpenMP the loops of the *_n functions are work-shared:
+    called inside a parallel region, e.g. one opened by WA_PARALLEL, the
+    iterations are divided statically between the threads of the team,
+    called outside one they run serially as before. WA_PARALLEL_FOR
+    threads a loop over cells of the caller directly. Both take the number
+    of threads and do not fork a team for fewer than two.
+
+    The floating point type is WA_REAL, double unless defined before the
+    header is included.
+
+    Fluent: add this file to the header files of the UDF library.
+    OpenFOAM: the kernels directory is on the include path of the model
+    libraries.
+
+==========================================================================*/
+
+#ifndef WrayAgarwalKernels_H
+#define WrayAgarwalKernels_H
+
+#include <math.h>
+
+#ifndef WA_REAL
+#   define WA_REAL double
+#endif
+
+typedef WA_REAL wa_real;
+
+#ifdef __cplusplus
+#   define WA_RESTRICT __restrict__
+#else
+#   define WA_RESTRICT restrict
+#endif
+
+#define WA_INLINE static inline
+
+// Lower bound of denominators
+#define WA_KERNEL_SMALL 1e-15
+
+// OpenMP threading of the loops over cells
+#ifdef _OPENMP
+#   define WA_PRAGMA(x) _Pragma(#x)
+#   define WA_OMP_FOR WA_PRAGMA(omp for schedule(static))
+#   define WA_PARALLEL(nThreads)                                              \
+        WA_PRAGMA(omp parallel num_threads(nThreads) if(nThreads > 1))
+#   define WA_PARALLEL_FOR(nThreads)                                          \
+        WA_PRAGMA                                                             \
+        (                                                                     \
+            omp parallel for schedule(static)                                 \
+            num_threads(nThreads) if(nThreads > 1)                            \
+        )
+#   define WA_PARALLEL_FOR_AND(nThreads, flag)                                \
+        WA_PRAGMA                                                             \
+        (                                                                     \
+            omp parallel for schedule(static)                                 \
+            num_threads(nThreads) if(nThreads > 1) reduction(&&:flag)         \
+        )
+#else
+#   define WA_OMP_FOR
+#   define WA_PARALLEL(nThreads)
+#   define WA_PARALLEL_FOR(nThreads)
+#   define WA_PARALLEL_FOR_AND(nThreads, flag)
+#endif
+
+
+// * * * * * * * * * * * * * * * * Utilities * * * * * * * * * * * * * * * //
+
+WA_INLINE wa_real wa_max(const wa_real a, const wa_real b)
+{
+    return a > b ? a : b;
+}
+
+WA_INLINE wa_real wa_min(const wa_real a, const wa_real b)
+{
+    return a < b ? a : b;
+}
+
+WA_INLINE wa_real wa_sqr(const wa_real a)
+{
+    return a*a;
+}
+
+
+// * * * * * * * * * * * * * * * Eddy viscosity  * * * * * * * * * * * * * //
+
+// Viscosity ratio
+WA_INLINE wa_real wa_chi(const wa_real R, const wa_real nu)
+{
+    return R/nu;
+}
+
+// Damping function chi^3/(chi^3 + Cw^3), Cw3 = Cw^3
+WA_INLINE wa_real wa_fmu(const wa_real chi, const wa_real Cw3)
+{
+    const wa_real chi3 = chi*chi*chi;
+    return chi3/(chi3 + Cw3);
+}
+
+// Kinematic eddy viscosity R*fmu
+WA_INLINE wa_real wa_nut(const wa_real R, const wa_real nu, const wa_real Cw3)
+{
+    return R*wa_fmu(wa_chi(R, nu), Cw3);
+}
+
+WA_INLINE void wa_nut_n
+(
+    const int n,
+    const wa_real* WA_RESTRICT R,
+    const wa_real* WA_RESTRICT nu,
+    const wa_real Cw3,
+    wa_real* WA_RESTRICT nut
+)
+{
+    int i;
+    WA_OMP_FOR
+    for (i=0; i<n; ++i)
+    {
+        nut[i] = wa_nut(R[i], nu[i], Cw3);
+    }
+}
+
+
+// * * * * * * * * * * * * * * * * Blending  * * * * * * * * * * * * * * * //
+
+// psi1 for f1 = 1 and psi2 for f1 = 0
+WA_INLINE wa_real wa_blend
+(
+    const wa_real f1,
+    const wa_real psi1,
+    const wa_real psi2
+)
+{
+    return f1*(psi1 - psi2) + psi2;
+}
+
+WA_INLINE wa_real wa_C1
+(
+    const wa_real f1,
+    const wa_real C1kw,
+    const wa_real C1ke
+)
+{
+    return wa_blend(f1, C1kw, C1ke);
+}
+
+WA_INLINE wa_real wa_sigmaR
+(
+    const wa_real f1,
+    const wa_real sigmakw,
+    const wa_real sigmake
+)
+{
+    return wa_blend(f1, sigmakw, sigmake);
+}
+
+WA_INLINE void wa_blend_n
+(
+    const int n,
+    const wa_real* WA_RESTRICT f1,
+    const wa_real psi1,
+    const wa_real psi2,
+    wa_real* WA_RESTRICT psi
+)
+{
+    int i;
+    WA_OMP_FOR
+    for (i=0; i<n; ++i)
+    {
+        psi[i] = wa_blend(f1[i], psi1, psi2);
+    }
+}
+
+
+// * * * * * * * * * * * * * * Velocity gradient * * * * * * * * * * * * * //
+
+// Square of the strain rate magnitude 2 S:S of the row-major velocity
+// gradient g, S = (g + g^T)/2. The terms are summed in the order of
+// 2*magSqr(symm(g)) of OpenFOAM, so that the result is bit-compatible.
+WA_INLINE wa_real wa_S2(const wa_real* g)
+{
+    const wa_real xy = 0.5*(g[1] + g[3]);
+    const wa_real xz = 0.5*(g[2] + g[6]);
+    const wa_real yz = 0.5*(g[5] + g[7]);
+
+    return 2.0*
+    (
+        g[0]*g[0] + 2*(xy*xy) + 2*(xz*xz)
+      + g[4]*g[4] + 2*(yz*yz)
+      + g[8]*g[8]
+    );
+}
+
+WA_INLINE void wa_S2_n
+(
+    const int n,
+    const wa_real* WA_RESTRICT g,
+    wa_real* WA_RESTRICT S2
+)
+{
+    int i;
+    WA_OMP_FOR
+    for (i=0; i<n; ++i)
+    {
+        S2[i] = wa_S2(g + 9*i);
+    }
+}
+
+// Strain rate magnitude sqrt(2 S:S)
+WA_INLINE wa_real wa_S(const wa_real* g)
+{
+    return sqrt(wa_S2(g));
+}
+
+// Vorticity magnitude sqrt(2 W:W), W = (g - g^T)/2. The components are
+// summed row by row as in sqrt(2*magSqr(skew(g))) of OpenFOAM, so that the
+// result is bit-compatible.
+WA_INLINE wa_real wa_W(const wa_real* g)
+{
+    const wa_real xy = 0.5*(g[1] - g[3]);
+    const wa_real xz = 0.5*(g[2] - g[6]);
+    const wa_real yz = 0.5*(g[5] - g[7]);
+
+    return sqrt
+    (
+        2.0*(xy*xy + xz*xz + xy*xy + yz*yz + xz*xz + yz*yz)
+    );
+}
+
+// Strain rate and vorticity magnitudes
+WA_INLINE void wa_SW(const wa_real* g, wa_real* S, wa_real* W)
+{
+    *S = wa_S(g);
+    *W = wa_W(g);
+}
+
+
+// * * * * * * * * * * * * * * Switch functions  * * * * * * * * * * * * * //
+
+// WA-2017 switch function of the wall distance y, limited to 0.9
+WA_INLINE wa_real wa_f1_2017
+(
+    const wa_real y,
+    const wa_real R,
+    const wa_real S,
+    const wa_real nu
+)
+{
+    const wa_real ySqrtRS = y*sqrt(R*S);
+    const wa_real arg1 =
+        (1 + ySqrtRS/nu)
+       /(1 + wa_sqr(wa_max(ySqrtRS, 1.5*R)/(20*nu)));
+
+    return wa_min(tanh(pow(arg1, 4.0)), 0.9);
+}
+
+WA_INLINE void wa_f1_2017_n
+(
+    const int n,
+    const wa_real* WA_RESTRICT y,
+    const wa_real* WA_RESTRICT R,
+    const wa_real* WA_RESTRICT S,
+    const wa_real* WA_RESTRICT nu,
+    wa_real* WA_RESTRICT f1
+)
+{
+    int i;
+    WA_OMP_FOR
+    for (i=0; i<n; ++i)
+    {
+        f1[i] = wa_f1_2017(y[i], R[i], S[i], nu[i]);
+    }
+}
+
+// WA-2018 wall distance free switch function from the k-omega estimates
+// omega = S/sqrt(Cmu) and k = nut*omega
+WA_INLINE wa_real wa_f1_2018
+(
+    const wa_real S,
+    const wa_real W,
+    const wa_real nut,
+    const wa_real nu,
+    const wa_real R,
+    const wa_real Cmu
+)
+{
+    const wa_real omega = S/sqrt(Cmu);
+    const wa_real k = nut*omega;
+    const wa_real eta = S*wa_max(1, fabs(W/S));
+    const wa_real arg1 =
+        (nu + R)/2*wa_sqr(eta)/wa_max(Cmu*k*omega, WA_KERNEL_SMALL);
+
+    return tanh(pow(arg1, 4.0));
+}
+
+
+// * * * * * * * * * * * * * * DES length scales * * * * * * * * * * * * * //
+
+// RANS length scale sqrt(R/S)
+WA_INLINE wa_real wa_lrans(const wa_real R, const wa_real S)
+{
+    return sqrt(R/S);
+}
+
+// DES length scale ratio of the RANS and LES length scales, CDESDelta is
+// CDES times the LES delta
+WA_INLINE wa_real wa_fdes_DES
+(
+    const wa_real R,
+    const wa_real S,
+    const wa_real CDESDelta
+)
+{
+    return wa_max(wa_lrans(R, S)/CDESDelta, 1);
+}
+
+// Denominator of rd, max(mag(grad(U)), SMALL)*sqr(kappa*y)
+WA_INLINE wa_real wa_rdDenom(const wa_real magGradU, const wa_real sqrKappaY)
+{
+    return wa_max(magGradU, WA_KERNEL_SMALL)*sqrKappaY;
+}
+
+// rd = nur/rdDenom limited to 10 without dividing by 0 at walls
+WA_INLINE wa_real wa_rd(const wa_real nur, const wa_real rdDenom)
+{
+    return nur < 10*rdDenom ? nur/rdDenom : 10;
+}
+
+// DDES shielding function 1 - tanh((Cd1*rd)^3)
+WA_INLINE wa_real wa_fd(const wa_real rd, const wa_real Cd1)
+{
+    const wa_real x = Cd1*rd;
+    return 1 - tanh(x*x*x);
+}
+
+// DDES length scale ratio
+WA_INLINE wa_real wa_fdes_DDES
+(
+    const wa_real lrans,
+    const wa_real fd,
+    const wa_real CDESDelta
+)
+{
+    const wa_real lddes = wa_max
+    (
+        lrans - fd*wa_max(0, lrans - CDESDelta),
+        WA_KERNEL_SMALL
+    );
+
+    return lrans/lddes;
+}
+
+// IDDES hill function fe1 and step function fb, which depend on the mesh
+// only through alpha = max(0.25 - y/hmax, -5)
+WA_INLINE void wa_IDDES_geometry
+(
+    const wa_real y,
+    const wa_real hmax,
+    wa_real* fHill,
+    wa_real* fStep
+)
+{
+    const wa_real alpha = wa_max(0.25 - y/hmax, -5);
+    const wa_real sqrAlpha = alpha*alpha;
+
+    // pow(exp(sqr(alpha)), -9)
+    const wa_real exp9 = exp(-9.0*sqrAlpha);
+
+    *fHill = 2*(alpha >= 0 ? exp(-11.09*sqrAlpha) : exp9);
+    *fStep = wa_min(2*exp9, 1);
+}
+
+// IDDES length scale ratio and the blending functions fd, fdtilda and fe.
+// rdDenom from wa_rdDenom, sqrCt = ct^2, sqrCl = cl^2
+WA_INLINE wa_real wa_fdes_IDDES
+(
+    const wa_real lrans,
+    const wa_real fHill,
+    const wa_real fStep,
+    const wa_real rdDenom,
+    const wa_real nut,
+    const wa_real nu,
+    const wa_real Cd1,
+    const wa_real sqrCt,
+    const wa_real sqrCl,
+    const wa_real CDESDelta,
+    wa_real* fd,
+    wa_real* fdtilda,
+    wa_real* fe
+)
+{
+    wa_real fei = 0;
+
+    *fd = wa_fd(wa_rd(nut + nu, rdDenom), Cd1);
+    *fdtilda = wa_max(1 - *fd, fStep);
+
+    // fe is 0 unless the hill function exceeds 1
+    if (fHill > 1)
+    {
+        const wa_real xt = sqrCt*wa_rd(nut, rdDenom);
+        const wa_real ft = tanh(xt*xt*xt);
+
+        const wa_real xl2 = wa_sqr(sqrCl*wa_rd(nu, rdDenom));
+        const wa_real xl4 = xl2*xl2;
+        const wa_real fl = tanh(xl4*xl4*xl2);
+
+        fei = (fHill - 1)*(1 - wa_max(ft, fl));
+    }
+
+    *fe = fei;
+
+    return lrans
+       /wa_max
+        (
+            *fdtilda*(1 + fei)*lrans + (1 - *fdtilda)*CDESDelta,
+            WA_KERNEL_SMALL
+        );
+}
+
+
+// * * * * * * * * * * * * * * * Source terms  * * * * * * * * * * * * * * //
+
+// The source terms per unit density. The linearised terms return the
+// coefficient of R, i.e. the source is the coefficient times R and its
+// derivative with respect to R is the coefficient.
+
+// Production C1*S
+WA_INLINE wa_real wa_prod(const wa_real C1, const wa_real S)
+{
+    return C1*S;
+}
+
+// First destruction term f1*C2kw*(grad(R) & grad(S))/S with invS = 1/S
+WA_INLINE wa_real wa_dest1
+(
+    const wa_real f1,
+    const wa_real C2kw,
+    const wa_real gradRGradS,
+    const wa_real invS
+)
+{
+    return f1*C2kw*gradRGradS*invS;
+}
+
+// Second destruction term -(1 - f1)*C2ke*R*magSqr(grad(S))/S2
+WA_INLINE wa_real wa_dest2
+(
+    const wa_real f1,
+    const wa_real C2ke,
+    const wa_real R,
+    const wa_real magSqrGradS,
+    const wa_real S2
+)
+{
+    return -(1 - f1)*C2ke*R*magSqrGradS/S2;
+}
+
+// Explicit second destruction term bounded by Cm*magSqr(grad(R))
+WA_INLINE wa_real wa_dest2_bounded
+(
+    const wa_real f1,
+    const wa_real C2ke,
+    const wa_real Cm,
+    const wa_real R,
+    const wa_real magSqrGradS,
+    const wa_real magSqrGradR,
+    const wa_real S2
+)
+{
+    return -(1 - f1)*wa_min(C2ke*R*R*magSqrGradS/S2, Cm*magSqrGradR);
+}
+
+// Implicit coefficient of the bounded second destruction term: the active
+// branch of the min divided by R, i.e.
+// wa_dest2_bounded = -(1 - f1)*wa_dest2_bounded_Sp*R
+WA_INLINE wa_real wa_dest2_bounded_Sp
+(
+    const wa_real C2ke,
+    const wa_real Cm,
+    const wa_real R,
+    const wa_real magSqrGradS,
+    const wa_real magSqrGradR,
+    const wa_real S2
+)
+{
+    return wa_min
+    (
+        C2ke*R*magSqrGradS/S2,
+        Cm*magSqrGradR/wa_max(R, WA_KERNEL_SMALL)
+    );
+}
+
+
+#endif